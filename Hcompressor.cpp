@@ -18,8 +18,8 @@ void Hcompressor::validateFile(ifstream& fp){
     
 }
 
-void Hcompressor::compressFile(ifstream& in, ofstream& out){
-    (this->tree).createTreeFromFile(in);
+bool Hcompressor::compressFile(ifstream& in, ofstream& out){
+    if (!(this->tree).createTreeFromFile(in)) return false;
     tree.encodeFile(in, out);
-    if (!out.is_open()) exit(1);
+    return out.is_open();
 }
@@ -6,7 +6,7 @@ public:
     Hcompressor();
     ~Hcompressor();
     void validateFile(std::ifstream& fp);
-    void compressFile(std::ifstream& in, std::ofstream& out);
+    bool compressFile(std::ifstream& in, std::ofstream& out);
 
 private:
     HuffmanTree tree;
@@ -11,10 +11,14 @@ Hdecompressor::~Hdecompressor(){
 
 }
 
-void Hdecompressor::generateEncodingScheme(ifstream& in) {
-    this->tree.createTreeFromScheme(in);
+bool Hdecompressor::generateEncodingScheme(ifstream& in) {
+    return this->tree.createTreeFromScheme(in);
 }
 
-void Hdecompressor::decompressFile(ifstream& in, ofstream& out) {
-    this->tree.decodeFile(in, out);
+bool Hdecompressor::decompressFile(ifstream& in, ofstream& out) {
+    return this->tree.decodeFile(in, out);
+}
+
+bool Hdecompressor::grepFile(ifstream& in, const string& pattern, ofstream& out) {
+    return this->tree.grepFile(in, pattern, out);
 }
\ No newline at end of file
@@ -5,8 +5,10 @@ class Hdecompressor {
 public:
     Hdecompressor();
     ~Hdecompressor();
-    void generateEncodingScheme(std::ifstream& in);
-    void decompressFile(std::ifstream& in, std::ofstream& out);
+    bool generateEncodingScheme(std::ifstream& in);
+    bool decompressFile(std::ifstream& in, std::ofstream& out);
+    bool grepFile(std::ifstream& in, const std::string& pattern, 
+            std::ofstream& out);
 
 private:
     HuffmanTree tree;
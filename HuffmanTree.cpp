@@ -2,6 +2,7 @@
 #include <queue>
 #include <bitpack.h>
 #include <iostream>
+#include <cstring>
 
 using namespace std;
 
@@ -43,18 +44,21 @@ struct WeightCompare {
 };
 
 Node* generate_parent(Node* left, Node* right);
-void HuffmanTree::createTreeFromFile(ifstream& fp){
+bool HuffmanTree::createTreeFromFile(istream& fp){
     /* To create the tree, first need to count the frequency of all 
     characters in the text file */
     vector<unsigned int> charCount(256);
     
     /* Method 2 */
     char* c = new char;
-    while (!fp.eof()) {
-        fp.read(c, 1);
-        charCount[(unsigned int) *c]++;
+    while (fp.read(c, 1)) {
+        charCount[(unsigned char) *c]++;
     }
     delete c;
+    if (charCount[255] > 0) { /* Character 255 is the pseudo EOF */
+        cerr << "Cannot compress a file that contains character 255" << endl;
+        return false;
+    }
 
     /* 
     Create a priority queue this priority queue performs comparison 
@@ -98,8 +102,10 @@ void HuffmanTree::createTreeFromFile(ifstream& fp){
         Q.push(parent); /* Push the new tree back */
     }
     /* The last node becomes the root */
+    postorder_delete(this->root); /* Remove possible existing tree */
     this->root = Q.top(); 
     Q.pop();
+    return true;
 }
 
 /* 
@@ -125,18 +131,23 @@ struct bitcode{
 };
 
 void find_encoding(Node* node, uint64_t ch, uint64_t bit, vector<bitcode>& table);
-void dispatch(ifstream& in, ofstream& out, vector<bitcode>& table);
-void bitpack_dispatch(ofstream& out, bitcode& res, uint64_t& bus, 
-                bitcode& pkg, uint64_t& ubit);
-void encoding_scheme_output(ofstream& out, vector<bitcode>& table);
+void dispatch(istream& in, ostream& out, vector<bitcode>& table,
+                vector<uint64_t>& blocks);
+void bitpack_dispatch(ostream& out, uint64_t& bus, bitcode& pkg, uint64_t& ubit);
+void encoding_scheme_output(ostream& out, vector<bitcode>& table);
+void block_index_output(ostream& out, vector<uint64_t>& blocks);
 
-void HuffmanTree::encodeFile(ifstream& in, ofstream& out){
+void HuffmanTree::encodeFile(istream& in, ostream& out){
     /* From the Huffman Tree, generate a 'symbol table' for the characters
     and its binary encoding 
     Also, the function assumes that the input and output file has been 
     opened in advance */
     vector<bitcode> table(256);
     find_encoding(this->root, 0x0, 0, table);
+    if (table[255].bit == 0) {
+        /* Empty file, the pseudo EOF is the root and still needs one bit */
+        table[255].bit = 1;
+    }
 
     /* Reset input file to the beginning*/
     in.clear();
@@ -144,10 +155,13 @@ void HuffmanTree::encodeFile(ifstream& in, ofstream& out){
     /* Output encoded scheme to file - have to do this later */
     encoding_scheme_output(out, table);
     /* Output the encoded file according to the encoding table */
-    dispatch(in, out, table);
+    vector<uint64_t> blocks;
+    dispatch(in, out, table, blocks);
+    /* Output the synchronization points used by grepFile */
+    block_index_output(out, blocks);
 }
 
-void encoding_scheme_output(ofstream& out, vector<bitcode>& table) {
+void encoding_scheme_output(ostream& out, vector<bitcode>& table) {
     int count = 0;
     for (int i = 0; i < 256; i++) {
         if (table[i].bit != 0) {
@@ -201,7 +215,7 @@ void find_encoding(Node* node, uint64_t ch, uint64_t bit,
         vector<bitcode>& table) {
     /* The table refers to the symbol table */
     if (node == NULL) {return;}
-    if (node->ch != 0x0) { 
+    if (node->left == NULL && node->right == NULL) { 
         /* Already at the leaves, update the encoding table */
         int index = node->ch;
         table[index].ch = ch;
@@ -223,22 +237,30 @@ void find_encoding(Node* node, uint64_t ch, uint64_t bit,
 Functions to read in characters from the input file and output to 
 the out file BIG ENDIAN order
 Need to encode the EOF 
+Also record the bit offset of every block start into blocks. A block 
+starts at the first line after at least GREP_BLOCK_SIZE characters, so 
+that a line never spans two blocks
 */
-void outputByteData(ofstream& out, uint64_t bus);
-void dispatch(ifstream& in, ofstream& out, vector<bitcode>& table) {
+const uint64_t GREP_BLOCK_SIZE = 16384;
+void outputByteData(ostream& out, uint64_t bus);
+void dispatch(istream& in, ostream& out, vector<bitcode>& table,
+                vector<uint64_t>& blocks) {
     /* Use a uint64_t bus and ubit to keep track of the bus to dispatch
      and the number of bit used thus far */
     uint64_t bus = 0;
     /* ubit is the number of bits used to represent a certain encoding */
     uint64_t ubit = 0;
+    /* nbit is the total number of bits dispatched so far */
+    uint64_t nbit = 0;
+    /* Number of characters in the current block */
+    uint64_t nchar = 0;
+    bool line_start = true;
     /* data is the holder for the character from file */
     char* data;
     unsigned char ch = 0;
-    /* Need to initialize bitcode or else memory error */
-    bitcode res;
-    res.ch = 0;
-    res.bit = 0;
 
+    blocks.clear();
+    blocks.push_back(0);
     data = new char;
     while (true){
         in.read(data, sizeof(char));
@@ -248,33 +270,27 @@ void dispatch(ifstream& in, ofstream& out, vector<bitcode>& table) {
             /* Note that if we reference ch after reading eof, 
             it shows the last character read*/
             bitcode pkg = table[255]; /* Pseudo-EOF */
-            bitpack_dispatch(out, res, bus, pkg, ubit);
+            bitpack_dispatch(out, bus, pkg, ubit);
             break;
         } else {
-            if (res.ch != 0x0) {
-                /* If there are some reserved bits, pack the reserve into the bus */
-                bitpack_dispatch(out, res, bus, res, ubit);
-                /* free the reserve code. This can be loose because the reserve adds at most
-                7 bits into the 64-bit bus
-                We only have reserve when the previous packing nears 64 bits
-                */
-                res.ch = 0x0; /* Reset the reserve */
-                res.bit = 0;
+            if (line_start && nchar >= GREP_BLOCK_SIZE) {
+                blocks.push_back(nbit); /* Start a new block here */
+                nchar = 0;
             }
             /* Get the encoding for character ch anyway */
             bitcode pkg = table[(int) ch];
             /* Package the bitcode into the bus */
-            bitpack_dispatch(out, res, bus, pkg, ubit);
+            bitpack_dispatch(out, bus, pkg, ubit);
+            nbit += pkg.bit;
+            nchar++;
+            line_start = (ch == '\n');
         }
     }
-    /* Last check for reserve bitcode, mostly for the case where by the pseudo eof
-    is not packaged fully in*/
-    if (res.ch != 0x0) bitpack_dispatch(out, res, bus, res, ubit);
+    delete data;
     outputByteData(out, bus); /* Output the last bus that contains EOF */
 }
 
-void bitpack_dispatch(ofstream& out, bitcode& res, uint64_t& bus, 
-                                    bitcode& pkg, uint64_t& ubit) {
+void bitpack_dispatch(ostream& out, uint64_t& bus, bitcode& pkg, uint64_t& ubit) {
 
     /* Number of bits to represent, get it as char and later cast it as uint64*/
     uint64_t w = pkg.bit; 
@@ -289,28 +305,27 @@ void bitpack_dispatch(ofstream& out, bitcode& res, uint64_t& bus,
         if (ubit + w == PACKET_SIZE) {
             /* Just full bus */
             bus = bitpack_newu(bus, rep, 0, w);
+            outputByteData(out, bus);
+            bus = 0; /* Reset the bus */
+            ubit = 0; 
         } else {
             /* partially bitpack rep into bus */
             /* Find the range to actually bit pack */
-            unsigned int used =  PACKET_SIZE - ubit; /* The number of bits used */
-            unsigned int unused = w - used; /* Number of bits unused */
-            unsigned char pkg = rep >> unused; /* Get the bits that are used part */
+            uint64_t used = PACKET_SIZE - ubit; /* The number of bits used */
+            uint64_t unused = w - used; /* Number of bits unused */
+            uint64_t head = rep >> unused; /* Get the bits that are used part */
             /* Pack the used bits into the bus */
-            bus = bitpack_newu(bus, pkg, 0, used);
-            /* update reserve */
-            unsigned char reserve = rep << (PACKET_SIZE - unused);
-            res.ch = reserve >> (PACKET_SIZE - unused); /* Get the unused part */
-            res.bit = unused; /* The number of bits unused, to be used next time */
-            // cout << "Bus: " << bus << " pkg: " << (int)pkg << " used: " << used << " w: " << w << endl;
-            // cout << "rep: " << (int) rep << " resch: " << (int)res.ch << " resbit: " << (int)res.bit << endl;
+            bus = bitpack_newu(bus, head, 0, used);
+            outputByteData(out, bus); /* Output the filled bus */
+            /* The unused part starts the next bus */
+            uint64_t tail = bitpack_getu(rep, 0, unused);
+            bus = bitpack_newu(0, tail, PACKET_SIZE - unused, unused);
+            ubit = unused;
         }
-        outputByteData(out, bus); /* Output the filled bus, note that the reserve is not empty */
-        bus = 0; /* Reset the bus */
-        ubit = 0; 
     }
 }
 
-void outputByteData(ofstream& out, uint64_t bus) {
+void outputByteData(ostream& out, uint64_t bus) {
     char* ptr = (char*) &bus; /*Assuming BigEndian order */
     int SIZE = (int) sizeof(uint64_t);
 
@@ -320,34 +335,58 @@ void outputByteData(ofstream& out, uint64_t bus) {
     // out.write(ptr, SIZE);
 }
 
+/*
+Output the block index after the bitstream. The decoder stops at the 
+pseudo EOF so it never reads this part. The layout is
+    block offsets   count
+    64 each         64      64
+all BIG ENDIAN, the last word is GREP_INDEX_MAGIC so that grepFile can 
+tell whether the file has an index
+*/
+const uint64_t GREP_INDEX_MAGIC = 0x4855464649445831; /* "HUFFIDX1" */
+void block_index_output(ostream& out, vector<uint64_t>& blocks) {
+    for (size_t i = 0; i < blocks.size(); i++) {
+        outputByteData(out, blocks[i]);
+    }
+    outputByteData(out, blocks.size());
+    outputByteData(out, GREP_INDEX_MAGIC);
+}
+
 /*
  * FUNCTIONS TO IMPLEMENT THE DECODING ALGORITHM
  * **************************************************************
  */
 
 
-void insertEncodingScheme(char* code, Node* node);
+bool insertEncodingScheme(char* code, Node* node);
 void insertPseudoEOFScheme(Node* node);
 
-void HuffmanTree::createTreeFromScheme(std::ifstream& in) {
-    string line;
+bool HuffmanTree::createTreeFromScheme(std::istream& in) {
+    char line[8];
     int count = 0;
     char* data;
     int CODE_SIZE = 10; 
     /* Note that encoding schemee is char(1) - repr(8) - bit(1) */
 
-    try{
-        getline(in, line);
-        cout << line << endl; // Testing purposes
-    } catch (std::ios_base::failure) {
+    /* The count is at most 256, so only read a few bytes for it. getline 
+    fails if there is no newline within them */
+    in.getline(line, sizeof(line));
+    if (!in || in.gcount() < 2) {
         cerr << "The compressed file format is incorrect" << endl;
-        exit(1);
+        return false;
+    }
+    cout << line << endl; // Testing purposes
+    /* Get the number of encoded chars, digits only */
+    for (int i = 0; line[i] != '\0'; i++) {
+        if (line[i] < '0' || line[i] > '9' || count > 256) {
+            cerr << "The compressed file format is incorrect" << endl;
+            return false;
+        }
+        count = count * 10 + (line[i] - '0');
     }
-    try{
-        count = stoi(line, NULL, 10); /* Get the number of encoded chars */
-    } catch (const std::out_of_range& oor) {
+    if (count < 1 || count > 256) { /* One code per char at most */
         cerr << "The compressed file format is incorrect" << endl;
-        exit(1);
+        return false;
     }
 
     postorder_delete(this->root); /* Remove possible existing tree */
@@ -357,33 +396,58 @@ void HuffmanTree::createTreeFromScheme(std::ifstream& in) {
     this->root->ch = 0;
 
     /* Get all the encoding scheme including the EOF */
+    bool ok = true;
+    bool has_eof = false;
     data = new char[CODE_SIZE];
-    for (int i = 0; i < count; i++) {
+    for (int i = 0; i < count && ok; i++) {
         try{
             /* Change from getting the encoding scheme from line by line
             to triplets of char */
             in.read(data, CODE_SIZE);
-            insertEncodingScheme(data, this->root);
-        } catch (std::ios_base::failure) {
+            if (in.gcount() != CODE_SIZE) {
+                cerr << "The compressed file format is incorrect" << endl;
+                ok = false;
+            } else {
+                has_eof = has_eof || ((unsigned char) *data == 255);
+                ok = insertEncodingScheme(data, this->root);
+            }
+        } catch (const std::ios_base::failure&) {
             cerr << "The compressed file format is incorrect" << endl;
+            ok = false;
         }
     }
     delete[] data;
+    if (ok && !has_eof) { /* Without the pseudo EOF decoding never stops */
+        cerr << "The compressed file format is incorrect" << endl;
+        ok = false;
+    }
+    if (!ok) { /* Do not keep a partially built tree */
+        postorder_delete(this->root);
+        this->root = NULL;
+    }
+    return ok;
 }
 
 /* Functions to insert a particular encoding into the Huffman Tree
   the node passed into the function is assumed to be the root of the tree
-  Expect each code to have exactly 3 bytes
+  Expect each code to have exactly 10 bytes
+  The code length is checked before walking so that a corrupted scheme 
+  cannot shift by more than 63 or grow a path longer than 64 nodes
+  Returns false if the code conflicts with the tree built so far
 */
-void insertEncodingScheme(char* code, Node* node) {
+bool insertEncodingScheme(char* code, Node* node) {
     /* Note that encoding scheme is char - repr - bit */
     /* Extract the encoded character*/
     unsigned char ch = *code;
     /* Extract the encoding representation */
-    uint64_t* encode_ptr = (uint64_t*) (code+1);
-    uint64_t encode = *(encode_ptr);
+    uint64_t encode;
+    memcpy(&encode, code+1, sizeof(uint64_t));
     /* Extract number of bits used to represent the character */
-    uint64_t bit = *(code+9);
+    uint64_t bit = (unsigned char) *(code+9);
+    if (bit == 0 || bit > 64 || (bit < 64 && (encode >> bit) != 0)) {
+        cerr << "Corrupted encoding scheme" << endl;
+        return false;
+    }
 
     /* Testing purposes */
     cout << (uint64_t) ch << " " << (uint64_t) encode << " " << bit << endl;
@@ -400,7 +464,7 @@ void insertEncodingScheme(char* code, Node* node) {
             } else {
                 if (cur->right->f != 0) {
                     cerr << "Corrupted encoding scheme" << endl;
-                    exit(1);
+                    return false;
                 }
                 cur = cur->right;
             }
@@ -414,7 +478,7 @@ void insertEncodingScheme(char* code, Node* node) {
             } else {
                 if (cur->left->f != 0) {
                     cerr << "Corrupted encoding scheme" << endl;
-                    exit(1);
+                    return false;
                 }
                 cur = cur->left;
             }
@@ -424,7 +488,7 @@ void insertEncodingScheme(char* code, Node* node) {
     if (encode & 0x1) { /* go right */
         if (cur->right != NULL) {
             cerr << "Corrupted encoding scheme" << endl;
-            exit(1);
+            return false;
         }
         cur->right = new Node;
         cur->right->left = cur->right->right = NULL;
@@ -434,16 +498,17 @@ void insertEncodingScheme(char* code, Node* node) {
     } else {
         if (cur->left != NULL) {
             cerr << "Corrupted encoding scheme" << endl;
-            exit(1); 
+            return false;
         }
         cur->left = new Node;
         cur->left->left = cur->left->right = NULL;
         cur->left->ch = ch;
         cur->left->f = 1; /* Denote f as the signal */
     }
+    return true;
 }
 
-void HuffmanTree::decodeFile(ifstream& in, ofstream& out) {
+bool HuffmanTree::decodeFile(istream& in, ostream& out) {
     /* Read in byte by byte from the file, keep a variable i on the
      * current number of bit, 
      * Keep a char variable on the current byte being analyzed
@@ -453,19 +518,21 @@ void HuffmanTree::decodeFile(ifstream& in, ofstream& out) {
     Node* cur;
     int i;
     bool end;
+    bool ok = true;
+    if (this->root == NULL) return false;
     cur = this->root;
     end = false; /* Not eof yet */
     char* data = new char; /* Dynamically allocated memory to store input from encoded file */
     char* output = new char;
 
-    while (in && !end) { /* While reading in byte by byte */
-        in.read(data, 1);
+    while (ok && !end && in.read(data, 1)) { /* While reading in byte by byte */
         byte = *data;
         for (i = 7; i >= 0; i--) { /* Go through each bit */
             if ((byte >> i) & 0x1) { /* If the bit is 1, go right */
                 if (cur->right == NULL) {
                     cerr << "Corrupted compressed file" << endl;
-                    exit(1);
+                    ok = false;
+                    break;
                 } 
                 cur = cur->right;
                 if (cur->f != 0) {
@@ -482,7 +549,8 @@ void HuffmanTree::decodeFile(ifstream& in, ofstream& out) {
             } else { /* If 0, go left */
                 if (cur->left == NULL) {
                     cerr << "Corrupted compressed file" << endl;
-                    exit(1);
+                    ok = false;
+                    break;
                 } 
                 cur = cur->left;
                 if (cur->f != 0) {
@@ -498,6 +566,212 @@ void HuffmanTree::decodeFile(ifstream& in, ofstream& out) {
             }
         }
     } 
+    if (ok && !end) { /* The input ended before the pseudo EOF */
+        cerr << "Corrupted compressed file" << endl;
+        ok = false;
+    }
     delete data;
     delete output;
+    return ok;
+}
+
+/*
+ * FUNCTIONS TO IMPLEMENT SEARCH OVER THE COMPRESSED FILE
+ * **************************************************************
+ */
+
+bool read_block_index(istream& in, uint64_t start, uint64_t size, 
+        vector<uint64_t>& blocks, uint64_t& nbit);
+uint64_t get_bits(vector<unsigned char>& buf, uint64_t pos);
+bool search_bits(vector<unsigned char>& buf, uint64_t from, uint64_t to, 
+        vector<unsigned char>& pattern);
+bool decode_bits(vector<unsigned char>& buf, uint64_t from, uint64_t to, 
+        Node* root, string& text);
+
+bool HuffmanTree::grepFile(istream& in, const string& pattern, ostream& out) {
+    /* Output every line of the original file that contains pattern.
+     * The tree is assumed to be built with createTreeFromScheme and the 
+     * input positioned at the start of the bitstream.
+     * The pattern is encoded into its bit code and searched for directly 
+     * in the bitstream, only the blocks with a candidate match are decoded
+     * Returns false if the pattern or the compressed file is invalid
+     */
+    if (pattern.find('\n') != string::npos) {
+        cerr << "Pattern cannot contain a newline" << endl;
+        return false;
+    }
+    if (this->root == NULL) return false;
+    vector<bitcode> table(256);
+    find_encoding(this->root, 0x0, 0, table);
+
+    /* Encode the pattern, one bit per entry */
+    vector<unsigned char> code;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        unsigned char ch = pattern[i];
+        if (table[ch].bit == 0) return true; /* Character never occurs in the file */
+        for (int j = table[ch].bit - 1; j >= 0; j--) {
+            code.push_back((table[ch].ch >> j) & 0x1);
+        }
+    }
+
+    /* Find the bitstream and its synchronization points */
+    if (!in) {
+        cerr << "Corrupted compressed file" << endl;
+        return false;
+    }
+    uint64_t start = in.tellg();
+    in.seekg(0, ios::end);
+    uint64_t size = in.tellg();
+    vector<uint64_t> blocks;
+    uint64_t nbit;
+    if (!read_block_index(in, start, size, blocks, nbit)) {
+        /* No index, treat the whole bitstream as one block */
+        blocks.assign(1, 0);
+        nbit = (size - start) * 8;
+    }
+    blocks.push_back(nbit);
+
+    vector<unsigned char> buf;
+    string text;
+    for (size_t b = 0; b + 1 < blocks.size(); b++) {
+        uint64_t from = blocks[b];
+        uint64_t to = blocks[b + 1];
+        if (from > to || to > nbit) {
+            cerr << "Corrupted compressed file" << endl;
+            return false;
+        }
+        /* Read only the bytes that cover this block, plus padding for get_bits */
+        uint64_t first = from / 8;
+        uint64_t last = (to + 7) / 8;
+        buf.assign(last - first + 8, 0);
+        in.clear();
+        in.seekg(start + first, ios::beg);
+        in.read((char*) buf.data(), last - first);
+        from -= first * 8;
+        to -= first * 8;
+
+        if (!search_bits(buf, from, to, code)) continue;
+
+        /* Candidate block, decode it and check line by line */
+        text.clear();
+        if (!decode_bits(buf, from, to, this->root, text)) {
+            cerr << "Corrupted compressed file" << endl;
+            return false;
+        }
+        size_t pos = 0;
+        while (pos < text.size()) {
+            /* Skip straight to the line of the next hit */
+            size_t hit = text.find(pattern, pos);
+            if (hit == string::npos || hit == text.size()) break;
+            size_t begin = (hit == 0) ? 0 : text.rfind('\n', hit - 1) + 1;
+            size_t end = text.find('\n', hit);
+            if (end == string::npos) end = text.size();
+            else end++;
+            out.write(text.data() + begin, end - begin);
+            if (text[end - 1] != '\n') out << endl;
+            pos = end;
+        }
+    }
+    return true;
+}
+
+/* Read the block index written by block_index_output. Returns false if
+  the file does not have one. nbit is set to the length of the bitstream */
+uint64_t readByteData(istream& in);
+bool read_block_index(istream& in, uint64_t start, uint64_t size, 
+        vector<uint64_t>& blocks, uint64_t& nbit) {
+    if (size < start + 16) return false;
+    in.clear();
+    in.seekg(size - 16, ios::beg);
+    uint64_t count = readByteData(in);
+    uint64_t magic = readByteData(in);
+    if (!in || magic != GREP_INDEX_MAGIC || count == 0) return false;
+    if (count > (size - start - 16) / 8) return false;
+
+    uint64_t index = size - 16 - count * 8;
+    in.seekg(index, ios::beg);
+    blocks.resize(count);
+    for (uint64_t i = 0; i < count; i++) {
+        blocks[i] = readByteData(in);
+    }
+    nbit = (index - start) * 8;
+    return (bool) in;
+}
+
+uint64_t readByteData(istream& in) {
+    /* Inverse of outputByteData, BIG ENDIAN order */
+    unsigned char bytes[8] = {0};
+    in.read((char*) bytes, 8);
+    uint64_t n = 0;
+    for (int i = 0; i < 8; i++) {
+        n = (n << 8) | bytes[i];
+    }
+    return n;
+}
+
+/* Get the 64 bits starting at bit pos of buf, MSB first. The buffer
+  is expected to be padded with 8 extra bytes */
+uint64_t get_bits(vector<unsigned char>& buf, uint64_t pos) {
+    uint64_t byte = pos / 8;
+    unsigned int shift = pos % 8;
+    uint64_t n = 0;
+    for (int i = 0; i < 8; i++) {
+        n = (n << 8) | buf[byte + i];
+    }
+    if (shift != 0) {
+        n = (n << shift) | (buf[byte + 8] >> (8 - shift));
+    }
+    return n;
+}
+
+/* Whether the bit code of the pattern starts at any bit in [from, to).
+  A hit is only a candidate since it need not be aligned to a character
+  code, the caller verifies it on the decoded text */
+bool search_bits(vector<unsigned char>& buf, uint64_t from, uint64_t to, 
+        vector<unsigned char>& pattern) {
+    uint64_t len = pattern.size();
+    if (len == 0) return true;
+    if (to - from < len) return false;
+
+    /* Compare the first (at most) 56 bits of the pattern in one go, so 
+    that a single 64 bit load covers the 8 bit offsets within a byte */
+    unsigned int w = len < 56 ? len : 56;
+    uint64_t head = 0;
+    for (unsigned int i = 0; i < w; i++) {
+        head = (head << 1) | pattern[i];
+    }
+    for (uint64_t byte = from / 8; byte * 8 + len <= to + 7; byte++) {
+        uint64_t window = get_bits(buf, byte * 8);
+        for (unsigned int shift = 0; shift < 8; shift++) {
+            uint64_t pos = byte * 8 + shift;
+            if (((window << shift) >> (64 - w)) != head) continue;
+            if (pos < from || pos + len > to) continue;
+            uint64_t i = w;
+            while (i < len && ((buf[(pos + i) / 8] >> (7 - (pos + i) % 8)) & 0x1) 
+                    == pattern[i]) {
+                i++;
+            }
+            if (i == len) return true;
+        }
+    }
+    return false;
+}
+
+/* Decode the bits in [from, to) into text, stopping at the pseudo EOF.
+  from is assumed to be a synchronization point. Returns false if the bits
+  lead off the tree */
+bool decode_bits(vector<unsigned char>& buf, uint64_t from, uint64_t to, 
+        Node* root, string& text) {
+    Node* cur = root;
+    for (uint64_t pos = from; pos < to; pos++) {
+        if ((buf[pos / 8] >> (7 - pos % 8)) & 0x1) cur = cur->right;
+        else cur = cur->left;
+        if (cur == NULL) return false;
+        if (cur->f != 0) {
+            if (cur->ch == 255) break; /* Reached the pseudo EOF */
+            text.push_back((char) cur->ch);
+            cur = root;
+        }
+    }
+    return true;
 }
@@ -1,6 +1,7 @@
 #ifndef _HUFFMAN_TREE_H
 #define _HUFFMAN_TREE_H
-#include <fstream>
+#include <iostream>
+#include <string>
 
 struct Node {
     uint64_t ch;
@@ -15,13 +16,18 @@ class HuffmanTree {
 
         ~HuffmanTree();
 
-        void createTreeFromFile(std::ifstream& fp);
+        /* The functions returning bool return false on invalid input
+        instead of exiting, so that they can be called repeatedly */
+        bool createTreeFromFile(std::istream& fp);
 
-        void createTreeFromScheme(std::ifstream& fp);
+        bool createTreeFromScheme(std::istream& fp);
 
-        void encodeFile(std::ifstream& in, std::ofstream& out);
+        void encodeFile(std::istream& in, std::ostream& out);
 
-        void decodeFile(std::ifstream& in, std::ofstream& out);
+        bool decodeFile(std::istream& in, std::ostream& out);
+
+        bool grepFile(std::istream& in, const std::string& pattern, 
+                std::ostream& out);
 
     private:
         Node* root;
@@ -0,0 +1,81 @@
+#include <HuffmanTree.h>
+#include <sstream>
+#include <stdint.h>
+#include <stddef.h>
+#include <cstdlib>
+
+using namespace std;
+
+/*
+ * Fuzz target for the decode entry points. Every input is treated as a
+ * compressed file and fed to createTreeFromScheme + decodeFile, and then
+ * to grepFile with a pattern taken from the decoded text.
+ * Build with -fsanitize=fuzzer for libFuzzer, or with -DFUZZ_STDIN_DRIVER
+ * for AFL and for replaying inputs by hand (see the Makefile)
+ */
+
+/* Stream buffer that drops everything, the decoder prints the scheme and
+  the errors which would only slow the fuzzer down */
+class NullBuffer : public streambuf {
+    protected:
+        int overflow(int c) { return c; }
+};
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static NullBuffer null;
+    streambuf* out_buf = cout.rdbuf(&null);
+    streambuf* err_buf = cerr.rdbuf(&null);
+
+    string bytes((const char*) data, size);
+    string text;
+    {
+        istringstream in(bytes);
+        ostringstream out;
+        HuffmanTree tree;
+        if (tree.createTreeFromScheme(in) && tree.decodeFile(in, out)) {
+            text = out.str();
+        }
+    }
+    {
+        /* Every code is at least one bit */
+        if (text.size() > size * 8) abort();
+
+        /* Search for the start of the first line so that grepFile also
+        gets to decode candidate blocks */
+        string pattern = text.substr(0, text.find('\n')).substr(0, 4);
+        istringstream in(bytes);
+        ostringstream out;
+        HuffmanTree tree;
+        if (tree.createTreeFromScheme(in)) {
+            tree.grepFile(in, pattern, out);
+        }
+    }
+
+    cout.rdbuf(out_buf);
+    cerr.rdbuf(err_buf);
+    return 0;
+}
+
+#ifdef FUZZ_STDIN_DRIVER
+#include <fstream>
+#include <iterator>
+
+/* Run each file given on the command line, or stdin if there are none */
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc || i == 1; i++) {
+        string bytes;
+        if (argc > 1) {
+            ifstream in(argv[i], ios::binary);
+            if (!in.is_open()) {
+                cerr << "Failure to open file " << argv[i] << endl;
+                return 1;
+            }
+            bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        } else {
+            bytes.assign(istreambuf_iterator<char>(cin), istreambuf_iterator<char>());
+        }
+        LLVMFuzzerTestOneInput((const uint8_t*) bytes.data(), bytes.size());
+    }
+    return 0;
+}
+#endif
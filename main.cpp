@@ -7,7 +7,9 @@ using namespace std;
 void print_correct_usage(char* str);
 
 int main(int argc, char** argv) {
-    if (argc != 4) {
+    /* -grep takes a pattern on top of the input and output files */
+    int expected = (argc > 1 && (string) argv[1] == "-grep") ? 5 : 4;
+    if (argc != expected) {
         print_correct_usage(argv[0]);
         exit(1);
     }
@@ -26,7 +28,7 @@ int main(int argc, char** argv) {
         /* Invoke compressor */
         Hcompressor compressor;
         compressor.validateFile(input);
-        compressor.compressFile(input, output);
+        if (!compressor.compressFile(input, output)) exit(1);
 
     } else if ((string) argv[1] == "-decompress") { /* Decompress file */
         input.open(argv[2]); /* Open input file */
@@ -37,8 +39,20 @@ int main(int argc, char** argv) {
         /* Open output file */
         output.open(argv[3], ios::out);
         Hdecompressor compressor;
-        compressor.generateEncodingScheme(input);
-        compressor.decompressFile(input, output);
+        if (!compressor.generateEncodingScheme(input)) exit(1);
+        if (!compressor.decompressFile(input, output)) exit(1);
+
+    } else if ((string) argv[1] == "-grep") { /* Search compressed file */
+        input.open(argv[3]); /* Open input file */
+        if (!input.is_open()) {
+            cerr << "Failure to open file " << argv[3] << endl;
+            exit(1);
+        }
+        /* Matching lines go to the output file */
+        output.open(argv[4], ios::out);
+        Hdecompressor compressor;
+        if (!compressor.generateEncodingScheme(input)) exit(1);
+        if (!compressor.grepFile(input, argv[2], output)) exit(1);
 
     } else {
         print_correct_usage(argv[0]);
@@ -53,4 +67,5 @@ int main(int argc, char** argv) {
 void print_correct_usage(char* str) {
     cout << "Incorrect command" << endl;
     cout << "Example: " << str << " -[option] inputfile outputfile" << endl; 
+    cout << "         " << str << " -grep pattern inputfile outputfile" << endl;
 }
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include <HuffmanTree.h>
+#include <sstream>
+#include <cstdlib>
+#include <random>
+
+using namespace std;
+
+/*
+ * Property tests for the encoder and decoder
+ *   round trip:   decodeFile(encodeFile(x)) == x for random inputs
+ *   differential: grepFile, which searches the bitstream and decodes only
+ *                 candidate blocks, gives the same lines as decodeFile
+ *                 followed by a plain line filter
+ *   hostile:      mutated compressed files are rejected or decoded without
+ *                 crashing, and the output is bounded by the input size
+ * Usage: test_huffman [seed] [iterations]
+ */
+
+int failures = 0;
+
+#define CHECK(cond, msg) do { \
+    if (!(cond)) { \
+        failures++; \
+        cerr << "FAIL: " << msg << " (" << #cond << ")" << endl; \
+    } \
+} while (0)
+
+class NullBuffer : public streambuf {
+    protected:
+        int overflow(int c) { return c; }
+};
+
+string compress(const string& data) {
+    istringstream in(data);
+    ostringstream out;
+    HuffmanTree tree;
+    if (!tree.createTreeFromFile(in)) return "";
+    tree.encodeFile(in, out);
+    return out.str();
+}
+
+bool decompress(const string& code, string& data) {
+    istringstream in(code);
+    ostringstream out;
+    HuffmanTree tree;
+    if (!tree.createTreeFromScheme(in) || !tree.decodeFile(in, out)) return false;
+    data = out.str();
+    return true;
+}
+
+bool grep(const string& code, const string& pattern, string& lines) {
+    istringstream in(code);
+    ostringstream out;
+    HuffmanTree tree;
+    if (!tree.createTreeFromScheme(in) || !tree.grepFile(in, pattern, out)) return false;
+    lines = out.str();
+    return true;
+}
+
+/* Reference for grep, a plain filter over the decoded lines */
+string filter_lines(const string& data, const string& pattern) {
+    string lines;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        size_t end = data.find('\n', pos);
+        string line = data.substr(pos, end == string::npos ? string::npos : end - pos);
+        if (line.find(pattern) != string::npos) lines += line + "\n";
+        if (end == string::npos) break;
+        pos = end + 1;
+    }
+    return lines;
+}
+
+/* Random input, every byte but the reserved pseudo EOF (255) */
+string random_input(mt19937& rng) {
+    static const size_t SIZES[] = {0, 1, 2, 3, 10, 100, 1000, 20000, 70000};
+    size_t n = SIZES[rng() % 9];
+    string data(n, '\0');
+    switch (rng() % 5) {
+        case 0: /* Uniform over all bytes, includes \0 and bytes >= 128 */
+            for (size_t i = 0; i < n; i++) data[i] = (char) (rng() % 255);
+            break;
+        case 1: /* Single symbol */
+            data.assign(n, (char) (rng() % 255));
+            break;
+        case 2: /* Skewed, gives long codes */
+            for (size_t i = 0; i < n; i++) {
+                int ch = 0;
+                while (ch < 254 && rng() % 4 == 0) ch++;
+                data[i] = (char) ch;
+            }
+            break;
+        default: { /* Text with short lines, spans several grep blocks */
+            static const char ALPHABET[] = "abcdefgh  \n\n\0\x80\xfe";
+            for (size_t i = 0; i < n; i++) data[i] = ALPHABET[rng() % 15];
+            break;
+        }
+    }
+    return data;
+}
+
+string random_pattern(mt19937& rng, const string& data) {
+    string pattern;
+    if (!data.empty() && rng() % 5 != 0) {
+        /* Part of the input, so that there is at least one match */
+        size_t i = rng() % data.size();
+        pattern = data.substr(i, 1 + rng() % 12);
+        pattern = pattern.substr(0, pattern.find('\n'));
+    } else {
+        for (size_t i = rng() % 4; i > 0; i--) pattern += (char) ('a' + rng() % 26);
+    }
+    return pattern;
+}
+
+/* Offset of the block index that follows the bitstream, read from the
+  count in front of the magic word */
+size_t index_offset(const string& code) {
+    uint64_t count = 0;
+    for (int i = 0; i < 8; i++) {
+        count = (count << 8) | (unsigned char) code[code.size() - 16 + i];
+    }
+    return code.size() - 16 - count * 8;
+}
+
+void test_round_trip(const string& data) {
+    string code = compress(data);
+    string back;
+    CHECK(decompress(code, back), "decompress " << data.size() << " bytes");
+    CHECK(back == data, "round trip " << data.size() << " bytes");
+}
+
+void test_grep(mt19937& rng, const string& data) {
+    string code = compress(data);
+    /* Also without the block index, which grepFile treats as one block */
+    string old_code = code.substr(0, index_offset(code));
+
+    for (int k = 0; k < 3; k++) {
+        string pattern = random_pattern(rng, data);
+        string expected = filter_lines(data, pattern);
+        string lines;
+        CHECK(grep(code, pattern, lines) && lines == expected,
+                "grep '" << pattern << "' in " << data.size() << " bytes");
+        CHECK(grep(old_code, pattern, lines) && lines == expected,
+                "grep '" << pattern << "' without index in " << data.size() << " bytes");
+    }
+}
+
+void test_hostile(mt19937& rng, const string& data) {
+    string code = compress(data);
+    size_t index = index_offset(code);
+    for (int k = 0; k < 8; k++) {
+        string bad = code;
+        bool truncated = false;
+        switch (rng() % 4) {
+            case 0: /* Flip bits anywhere */
+                for (int i = rng() % 8; i >= 0; i--) {
+                    bad[rng() % bad.size()] ^= (char) (1 << (rng() % 8));
+                }
+                break;
+            case 1: /* Truncate */
+                bad.resize(rng() % bad.size());
+                /* The pseudo EOF is in the last word of the bitstream, or the
+                one before if the last word is only padding */
+                truncated = (bad.size() + 16 <= index);
+                break;
+            case 2: { /* Bad count line */
+                static const char* COUNTS[] = {"", "x", "-1", "0", "257", "99999999999", 
+                        "12abc", " 12"};
+                bad = string(COUNTS[rng() % 8]) + bad.substr(bad.find('\n'));
+                break;
+            }
+            default: { /* Bad code length in the first entry */
+                static const unsigned char BITS[] = {0, 63, 64, 65, 128, 255};
+                size_t i = bad.find('\n') + 10;
+                if (i < bad.size()) bad[i] = (char) BITS[rng() % 6];
+                break;
+            }
+        }
+        string back;
+        bool ok = decompress(bad, back);
+        CHECK(!(ok && truncated), "reject cut at " << bad.size() << " of " << code.size());
+        if (ok) {
+            CHECK(back.size() <= bad.size() * 8, "output bounded by input");
+        }
+        string lines;
+        grep(bad, random_pattern(rng, data), lines);
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned int seed = argc > 1 ? strtoul(argv[1], NULL, 10) : 1;
+    int iterations = argc > 2 ? atoi(argv[2]) : 200;
+    mt19937 rng(seed);
+
+    /* The library prints the encoding scheme and its errors */
+    NullBuffer null;
+    ostringstream log;
+    streambuf* out_buf = cout.rdbuf(&null);
+    streambuf* err_buf = cerr.rdbuf(log.rdbuf());
+
+    for (int i = 0; i < iterations; i++) {
+        string data = random_input(rng);
+        test_round_trip(data);
+        test_grep(rng, data);
+        test_hostile(rng, data);
+    }
+    /* Character 255 is the pseudo EOF and must be rejected */
+    istringstream in(string("ab\xff", 3));
+    HuffmanTree tree;
+    CHECK(!tree.createTreeFromFile(in), "reject character 255");
+
+    cout.rdbuf(out_buf);
+    cerr.rdbuf(err_buf);
+    /* Only keep the failures from the log */
+    istringstream lines(log.str());
+    string line;
+    while (getline(lines, line)) {
+        if (line.compare(0, 5, "FAIL:") == 0) cerr << line << endl;
+    }
+    cout << iterations << " iterations, seed " << seed << ", "
+         << failures << " failures" << endl;
+    return failures == 0 ? 0 : 1;
+}